@@ -0,0 +1,130 @@
+#ifndef decisionGrid_h
+#define decisionGrid_h
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+/******************************************************************************/
+// Precomputed copy of a policy's decision (push left or right) over the
+// rectangle [-maxX, maxX] x [-maxV, maxV] of the state space.
+//
+// The rectangle is split into nx * nv cells and each cell stores the
+// decision at its centre as one bit. Cells whose corners and centre do not
+// all agree straddle the decision boundary and are refined into
+// refine * refine sub-cells with a bit each. Refined cells are located with a
+// popcount rank over the "mixed" bitmap, so a lookup is a couple of index
+// computations and at most two bit tests, and the memory footprint is fixed
+// once the grid is built.
+class DecisionGrid {
+ public:
+  /************************************************************************/
+  DecisionGrid(double maxX, double maxV, int nx, int nv, int refine)
+      : minX(-maxX),
+        minV(-maxV),
+        nx(nx),
+        nv(nv),
+        refine(refine),
+        dx(2 * maxX / nx),
+        dv(2 * maxV / nv),
+        numMixed(0) {}
+
+  /************************************************************************/
+  // sample policy(x, v), which returns an action as passed to
+  // cartCentering::update, over the grid
+  template <typename Policy>
+  void build(Policy policy) {
+    const int cells = nx * nv;
+    coarse.assign(words(cells), 0);
+    mixed.assign(words(cells), 0);
+    rank.assign(words(cells), 0);
+    fine.clear();
+
+    // decisions on the cell corners, shared between neighbouring cells
+    std::vector<bool> corner((nx + 1) * (nv + 1));
+    for (int j = 0; j <= nv; j++)
+      for (int i = 0; i <= nx; i++)
+        corner[j * (nx + 1) + i] = policy(minX + i * dx, minV + j * dv) < 0;
+
+    numMixed = 0;
+    for (int j = 0; j < nv; j++) {
+      for (int i = 0; i < nx; i++) {
+        int c = j * nx + i;
+        bool left = policy(minX + (i + 0.5) * dx, minV + (j + 0.5) * dv) < 0;
+        if (left) set(coarse, c);
+        bool boundary = corner[j * (nx + 1) + i] != left ||
+                        corner[j * (nx + 1) + i + 1] != left ||
+                        corner[(j + 1) * (nx + 1) + i] != left ||
+                        corner[(j + 1) * (nx + 1) + i + 1] != left;
+        if (!boundary) continue;
+
+        // refined cells are appended in cell order, matching the rank
+        set(mixed, c);
+        fine.resize(words((numMixed + 1) * refine * refine), 0);
+        for (int sj = 0; sj < refine; sj++)
+          for (int si = 0; si < refine; si++) {
+            double x = minX + (i + (si + 0.5) / refine) * dx;
+            double v = minV + (j + (sj + 0.5) / refine) * dv;
+            if (policy(x, v) < 0)
+              set(fine, numMixed * refine * refine + sj * refine + si);
+          }
+        numMixed++;
+      }
+    }
+
+    for (size_t w = 1; w < rank.size(); w++)
+      rank[w] = rank[w - 1] + __builtin_popcountll(mixed[w - 1]);
+  }
+
+  /************************************************************************/
+  // action for state (x, v); states outside the rectangle use the nearest
+  // cell on its edge
+  int action(double x, double v) const {
+    double fx = std::min(std::max((x - minX) / dx, 0.0), (double)nx);
+    double fv = std::min(std::max((v - minV) / dv, 0.0), (double)nv);
+    int i = std::min((int)fx, nx - 1);
+    int j = std::min((int)fv, nv - 1);
+    int c = j * nx + i;
+    if (!test(mixed, c)) return test(coarse, c) ? -1 : 1;
+
+    uint64_t below = mixed[c >> 6] & ((uint64_t(1) << (c & 63)) - 1);
+    int k = rank[c >> 6] + __builtin_popcountll(below);
+    int si = std::min((int)((fx - i) * refine), refine - 1);
+    int sj = std::min((int)((fv - j) * refine), refine - 1);
+    return test(fine, k * refine * refine + sj * refine + si) ? -1 : 1;
+  }
+
+  /************************************************************************/
+  // memory used by the lookup tables
+  size_t bytes() const {
+    return (coarse.size() + mixed.size() + fine.size()) * sizeof(uint64_t) +
+           rank.size() * sizeof(uint32_t);
+  }
+  int getNumCells() const { return nx * nv; }
+  int getNumRefined() const { return numMixed; }
+
+ private:
+  static size_t words(size_t bits) { return (bits + 63) / 64; }
+  static void set(std::vector<uint64_t>& b, size_t i) {
+    b[i >> 6] |= uint64_t(1) << (i & 63);
+  }
+  static bool test(const std::vector<uint64_t>& b, size_t i) {
+    return (b[i >> 6] >> (i & 63)) & 1;
+  }
+
+  double minX;
+  double minV;
+  int nx;
+  int nv;
+  int refine;
+  double dx;  // cell width in x
+  double dv;  // cell width in v
+  int numMixed;                   // number of refined cells
+  std::vector<uint64_t> coarse;   // decision at each cell centre (1 = left)
+  std::vector<uint64_t> mixed;    // cells refined near the boundary
+  std::vector<uint32_t> rank;     // refined cells before each mixed word
+  std::vector<uint64_t> fine;     // sub-cell decisions of refined cells
+};
+#endif
@@ -60,11 +60,24 @@ class cartCentering {
     } while (terminal());
   }
 
+  /************************************************************************/
+  // start an episode from a given state
+  void reset(double x, double v) {
+    step = 0;
+    state[X] = x;
+    state[V] = v;
+  }
+
+  /************************************************************************/
+  bool solved() {
+    return abs(state[X]) <= NEAR_ORIGIN && abs(state[V]) <= NEAR_ORIGIN;
+  }
+
   /************************************************************************/
   bool terminal() {
     if (step >= max_step)
       return true;
-    else if (abs(state[X]) <= NEAR_ORIGIN && abs(state[V]) <= NEAR_ORIGIN)
+    else if (solved())
       return true;
     else if (abs(state[X]) > MAX_X)
       return true;
@@ -81,6 +94,79 @@ class cartCentering {
     state[V] = bound(state[V], -MAX_V, MAX_V);
     step++;
     if (animate) draw(action);
+    return reward();
+  }
+
+  /************************************************************************/
+  // Apply a constant action for up to k steps, stopping early at a terminal
+  // state, without stepping one at a time. Under a constant force the
+  // velocity after i steps is v0 + i*dv clamped to MAX_V, and the position
+  // is its running sum, so both have closed forms. The position is monotone
+  // before and after the velocity changes sign, which lets the first step
+  // leaving the track be found by binary search; the near-origin window is
+  // only a few steps wide and is scanned. Returns the reward update() would
+  // return on the last step taken and sets taken to the number of steps.
+  // Agrees with repeated update() calls up to floating-point rounding.
+  double advance(const int& action, const int& k, int& taken) {
+    taken = 0;
+    int limit = std::min(k, max_step - step);
+    if (limit <= 0) return reward();
+
+    // mirror so that the force is positive: y = s*x, w = s*v
+    double s = action < 0 ? -1.0 : 1.0;
+    double dw = TAU * FORCE_MAG / MASSCART;
+    double y0 = s * state[X];
+    double w0 = s * state[V];
+
+    // velocity is clamped from step m onwards
+    double m = std::max(0.0, ceil((MAX_V - w0) / dw));
+    auto vel = [&](double i) { return std::min(w0 + i * dw, MAX_V); };
+    auto pos = [&](double n) {
+      double u = std::min(n, m);
+      double sum = u * w0 + dw * u * (u - 1) / 2 + (n - u) * MAX_V;
+      return y0 + TAU * sum;
+    };
+    // first n in [lo, hi] with pred(n), for pred monotone false -> true;
+    // limit + 1 if there is none
+    auto first = [&](int lo, int hi, auto pred) {
+      int end = hi;
+      while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (pred(mid))
+          hi = mid - 1;
+        else
+          lo = mid + 1;
+      }
+      return lo <= end ? lo : limit + 1;
+    };
+
+    // position falls until the velocity turns non-negative, then rises
+    int turn = (int)std::min((double)limit, std::max(0.0, ceil(-w0 / dw)));
+    int n = limit;
+    n = std::min(n, first(1, turn, [&](int i) { return pos(i) < -MAX_X; }));
+    n = std::min(n, first(std::max(turn, 1), limit,
+                          [&](int i) { return pos(i) > MAX_X; }));
+
+    // near-origin window, widened by a step on each side against rounding
+    int lo = (int)std::max(1.0, ceil((-NEAR_ORIGIN - w0) / dw) - 1);
+    int hi = (int)std::min((double)n - 1, floor((NEAR_ORIGIN - w0) / dw) + 1);
+    for (int i = lo; i <= hi; i++) {
+      if (abs(vel(i)) <= NEAR_ORIGIN && abs(pos(i)) <= NEAR_ORIGIN) {
+        n = i;
+        break;
+      }
+    }
+
+    state[X] = s * pos(n);
+    state[V] = s * vel(n);
+    step += n;
+    taken = n;
+    return reward();
+  }
+
+  /************************************************************************/
+  // reward for the current state: a penalty on terminal states, else 0
+  double reward() {
     if (terminal()) {
       double x = (abs(state[X]) / MAX_X) * 1.0;
       double v = (abs(state[V]) / MAX_V) * 0.5;
@@ -96,20 +182,21 @@ class cartCentering {
   }
   double getCartXPos() { return state[X]; }
   double getCartXVel() { return state[V]; }
+  double getMaxX() { return MAX_X; }
+  double getMaxV() { return MAX_V; }
+  double getMinVarIni() { return MIN_VAR_INI; }
+  double getMaxVarIni() { return MAX_VAR_INI; }
   void setDraw(bool d) { draw_track = d; }
 
   /************************************************************************/
   void draw(const int& action) {
     clearScreen();
-    bool solved =
-        (abs(state[X]) <= NEAR_ORIGIN && abs(state[V]) <= NEAR_ORIGIN);
-
     std::cout << "Step: " << step << std::endl;
     std::cout << "X " << std::setprecision(3) << state[X] << std::endl;
     std::cout << "V " << std::setprecision(3) << state[V] << std::endl;
     std::cout << "Action: " << (action < 0 ? "<--" : "-->") << std::endl;
     if (terminal())
-      std::cout << "Solved: " << (solved ? "YES!" : "NO") << std::endl;
+      std::cout << "Solved: " << (solved() ? "YES!" : "NO") << std::endl;
     else
       std::cout << "Solved:" << std::endl;
 
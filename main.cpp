@@ -1,12 +1,26 @@
 #include <math.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <limits>
+#include <memory>
 #include <random>
+#include <sstream>
 #include <stack>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <queue>
 
+#include "DecisionGrid.h"
 #include "RocketCentering.h"
 
 using namespace std;
@@ -49,21 +63,71 @@ int arity(string op) {
     return 2;
 }
 
+// Ephemeral random constants: a new terminal is a constant with probability
+// ERC_PROB, drawn uniformly from [-ERC_MAX, ERC_MAX] and kept to three
+// decimals, and is otherwise a or b
+const double ERC_PROB = 0.2;
+const double ERC_MAX = 2.0;
+
+// return a random terminal token
+string randTerminal(mt19937& rng) {
+  if (randDouble(rng) >= ERC_PROB) return randChoice(rng) ? "a" : "b";
+  stringstream ss;
+  ss << fixed << setprecision(3)
+     << std::uniform_real_distribution<>{-ERC_MAX, ERC_MAX}(rng);
+  return ss.str();
+}
+
 typedef string Elem;
 
+// closed range [lo, hi] of values a subtree can take; the bounds may be
+// infinite when a subtree is unbounded over the input domain
+struct Interval {
+  double lo;
+  double hi;
+  Interval(double _lo, double _hi) : lo(_lo), hi(_hi) {}
+  Interval(double x = 0) : lo(x), hi(x) {}
+  bool isPoint() const { return lo == hi; }
+};
+
+// actions taken in one episode, one bit per step (1 = push left)
+struct ActionTrace {
+  vector<uint64_t> bits;
+  int steps = 0;
+  void push(bool left) {
+    if (steps % 64 == 0) bits.push_back(0);
+    if (left) bits.back() |= uint64_t(1) << (steps % 64);
+    steps++;
+  }
+  bool left(int i) const { return (bits[i / 64] >> (i % 64)) & 1; }
+};
+
 class LinkedBinaryTree {
  public:
+  // A node owns its children: deleting a node deletes its whole subtree.
+  // Nodes are only linked into and out of a tree by LinkedBinaryTree, which
+  // frees whatever it unlinks, so every node has exactly one owner.
   struct Node {
     Elem elt;
     string name;
     Node* par;
     Node* left;
     Node* right;
-    Node() : elt(), par(NULL), name(""), left(NULL), right(NULL) {}
+    double val;  // value of a constant leaf, parsed once from elt
+    Node() : elt(), par(NULL), name(""), left(NULL), right(NULL), val(0) {
+      live++;
+    }
+    Node(const Node&) = delete;
+    ~Node() {
+      delete left;
+      delete right;
+      live--;
+    }
     int depth() {
       if (par == NULL) return 0;
       return par->depth() + 1;
     }
+    static inline atomic<long> live{0};  // nodes currently allocated
   };
 
   class Position {
@@ -74,9 +138,7 @@ class LinkedBinaryTree {
     Position(Node* _v = NULL) : v(_v) {}
     Elem& operator*() { return v->elt; }
     Position left() const { return Position(v->left); }
-    void setLeft(Node* n) { v->left = n; }
     Position right() const { return Position(v->right); }
-    void setRight(Node* n) { v->right = n; }
     Position parent() const  // get parent
     {
       return Position(v->par);
@@ -102,43 +164,87 @@ class LinkedBinaryTree {
     score = t.getScore();
     steps = t.getSteps();
     generation = t.getGeneration();
+    traces = t.traces;
+    for (auto& m : t.mutations)
+      mutations.push_back(
+          {m.path, unique_ptr<Node>(copyPreOrder(m.old.get()))});
+  }
+
+  // move constructor: takes over t's nodes, leaving t empty
+  LinkedBinaryTree(LinkedBinaryTree&& t) noexcept
+      : score(t.score), steps(t.steps), generation(t.generation) {
+    _root = t.release();
+    traces.swap(t.traces);
+    mutations.swap(t.mutations);
   }
 
   // copy assignment operator
   LinkedBinaryTree& operator=(const LinkedBinaryTree& t) {
     if (this != &t) {
       // if tree already contains data, delete it
-      if (_root != NULL) {
-        PositionList pl = positions();
-        for (auto& p : pl) delete p.v;
-      }
+      delete _root;
+      clearMutations();
       _root = copyPreOrder(t.root());
       score = t.getScore();
       steps = t.getSteps();
       generation = t.getGeneration();
+      traces = t.traces;
+      for (auto& m : t.mutations)
+        mutations.push_back(
+            {m.path, unique_ptr<Node>(copyPreOrder(m.old.get()))});
+    }
+    return *this;
+  }
+
+  // move assignment operator
+  LinkedBinaryTree& operator=(LinkedBinaryTree&& t) noexcept {
+    if (this != &t) {
+      delete _root;
+      _root = t.release();
+      score = t.getScore();
+      steps = t.getSteps();
+      generation = t.getGeneration();
+      traces.swap(t.traces);
+      mutations.swap(t.mutations);
     }
     return *this;
   }
 
   // destructor
   ~LinkedBinaryTree() {
-    if (_root != NULL) {
-      PositionList pl = positions();
-      for (auto& p : pl) delete p.v;
-    }
+    delete _root;
+    clearMutations();
   }
 
-  int size() const { return size(_root); }
+  int size() const { return _root == NULL ? 0 : size(_root); }
   int size(Node* root) const;
   int depth() const;
   bool empty() const { return size() == 0; };
   Node* root() const { return _root; }
   PositionList positions() const;
-  void addRoot() { _root = new Node; }
-  void addRoot(Elem e) {
+  void addRoot() {
+    setTraces({});
+    delete _root;
     _root = new Node;
-    _root->elt = e;
   }
+  void addRoot(Elem e) {
+    addRoot();
+    setTerminal(_root, e);
+  }
+  // give up ownership of all nodes, leaving the tree empty
+  Node* release() {
+    Node* r = _root;
+    _root = NULL;
+    return r;
+  }
+  static long liveNodes() { return Node::live; }
+  const vector<ActionTrace>& getTraces() const { return traces; }
+  void setTraces(vector<ActionTrace> t) {
+    traces.swap(t);
+    clearMutations();
+  }
+  bool unchangedAt(double a, double b) const;
+  long mutationNodes() const;
   void nameRoot(string name) { _root->name = name; }
   void addLeftChild(const Position& p, const Node* n);
   void addLeftChild(const Position& p);
@@ -146,10 +252,26 @@ class LinkedBinaryTree {
   void addRightChild(const Position& p);
   void printExpression() { printExpression(_root); }
   void printExpression(Node* v);
-  double evaluateExpression(double a, double b) {
+  void exportExpression(ostream& os) const { exportExpression(_root, os); }
+  void exportExpression(Node* v, ostream& os) const;
+  double evaluateExpression(double a, double b) const {
     return evaluateExpression(Position(_root), a, b);
   };
-  double evaluateExpression(const Position& p, double a, double b);
+  double evaluateExpression(const Position& p, double a, double b) const;
+  void evaluateBatch(const vector<double>& a, const vector<double>& b,
+                     vector<double>& out) const {
+    int k = 0;
+    evaluateBatch(_root, a, b, {}, k, out);
+  }
+  void evaluateBatch(const vector<double>& a, const vector<double>& b,
+                     const vector<vector<double>>& c,
+                     vector<double>& out) const {
+    int k = 0;
+    evaluateBatch(_root, a, b, c, k, out);
+  }
+  void evaluateBatch(Node* v, const vector<double>& a, const vector<double>& b,
+                     const vector<vector<double>>& c, int& k,
+                     vector<double>& out) const;
   long getGeneration() const { return generation; }
   void setGeneration(int g) { generation = g; }
   double getScore() const { return score; }
@@ -163,48 +285,187 @@ class LinkedBinaryTree {
   void Crossover(mt19937 &rng, LinkedBinaryTree &P1, LinkedBinaryTree &P2); //Declaration of crossover function
   void deleteSubtreeMutator(mt19937 &rng);
   void addSubtreeMutator(mt19937& rng, const int maxDepth);
+  bool constantMutator(mt19937& rng, const double& sigma);
+  vector<double> getConstants() const;
+  void setConstants(const vector<double>& c);
+  Interval range(const Interval& a, const Interval& b) const {
+    return range(_root, a, b);
+  }
+  Interval range(Node* v, const Interval& a, const Interval& b) const;
+  bool constantAction(const Interval& a, const Interval& b, int& action) const;
+  void prune(const Interval& a, const Interval& b) { prune(_root, a, b); }
+  Interval prune(Node* v, const Interval& a, const Interval& b);
   bool LexLessThan(const LinkedBinaryTree &A, const LinkedBinaryTree &B); //Decleration of LexLessThan function
 
 protected:                                         // local utilities
   void preorder(Node* v, PositionList& pl) const;  // preorder utility
   Node* copyPreOrder(const Node* root);
+  void replaceSubtree(const Position& p, Node* n);
+  static void setTerminal(Node* v, const Elem& e);
+  static void setConstant(Node* v, double c);
+  static bool isConstant(const Node* v);
+  void clearMutations();
   double score;     // mean reward over 20 episodes
   double steps;     // mean steps-per-episode over 20 episodes
   long generation;  // which generation was tree "born"
+
+  // Action traces from the tree's last evaluation on the episode bank (copied
+  // to children with the tree), and the places the tree has been changed
+  // since: the path from the root ('l'/'r' per step) and the subtree that
+  // was there, owned by the record. Empty unless prefix reuse is in use.
+  struct Mutation {
+    string path;
+    unique_ptr<Node> old;
+  };
+  vector<ActionTrace> traces;
+  vector<Mutation> mutations;
  private:
   Node* _root;  // pointer to the root
 };
 
-// add the tree rooted at node child as this tree's left child
+// add the tree rooted at node child as this tree's left child, replacing
+// (and deleting) any existing left subtree
 void LinkedBinaryTree::addLeftChild(const Position& p, const Node* child) {
   Node* v = p.v;
+  setTraces({});  // untracked change
+  delete v->left;
   v->left = copyPreOrder(child);  // deep copy child
   v->left->par = v;
 }
 
-// add the tree rooted at node child as this tree's right child
+// add the tree rooted at node child as this tree's right child, replacing
+// (and deleting) any existing right subtree
 void LinkedBinaryTree::addRightChild(const Position& p, const Node* child) {
   Node* v = p.v;
+  setTraces({});  // untracked change
+  delete v->right;
   v->right = copyPreOrder(child);  // deep copy child
   v->right->par = v;
 }
 
 void LinkedBinaryTree::addLeftChild(const Position& p) {
   Node* v = p.v;
+  setTraces({});  // untracked change
+  delete v->left;
   v->left = new Node;
   v->left->par = v;
 }
 
 void LinkedBinaryTree::addRightChild(const Position& p) {
   Node* v = p.v;
+  setTraces({});  // untracked change
+  delete v->right;
   v->right = new Node;
   v->right->par = v;
 }
 
+// put the subtree rooted at n (which this tree takes ownership of) in place
+// of the subtree at p, deleting the subtree at p. A tree with action traces
+// keeps the replaced subtree as a mutation record instead, unless an earlier
+// record already covers p; a change above an earlier record cannot be
+// described by records, so the traces are dropped.
+void LinkedBinaryTree::replaceSubtree(const Position& p, Node* n) {
+  Node* v = p.v;
+  Node* parent = v->par;
+  string path;
+  for (Node* c = v; c->par != NULL; c = c->par)
+    path.insert(path.begin(), c->par->left == c ? 'l' : 'r');
+
+  if (parent == NULL)
+    _root = n;
+  else if (parent->left == v)
+    parent->left = n;
+  else
+    parent->right = n;
+  n->par = parent;
+  v->par = NULL;
+
+  if (traces.empty()) {
+    delete v;
+    return;
+  }
+  for (auto& m : mutations) {
+    if (path.compare(0, m.path.size(), m.path) == 0) {
+      delete v;  // inside an earlier record
+      return;
+    }
+    if (m.path.compare(0, path.size(), path) == 0) {
+      delete v;  // above an earlier record
+      setTraces({});
+      return;
+    }
+  }
+  mutations.push_back({path, unique_ptr<Node>(v)});
+}
+
+// make v a terminal leaf for token e: a, b or a constant
+void LinkedBinaryTree::setTerminal(Node* v, const Elem& e) {
+  v->elt = e;
+  if (!isOp(e) && e != "a" && e != "b") v->val = stod(e);
+}
+
+// make v a constant leaf with value c; elt is written with enough digits to
+// parse back to c, so printed trees reproduce the evolved ones exactly
+void LinkedBinaryTree::setConstant(Node* v, double c) {
+  stringstream ss;
+  ss << setprecision(numeric_limits<double>::max_digits10) << c;
+  v->elt = ss.str();
+  v->val = c;
+}
+
+bool LinkedBinaryTree::isConstant(const Node* v) {
+  return v->left == NULL && v->right == NULL && v->elt != "a" &&
+         v->elt != "b";
+}
+
+// values of the constant leaves, in preorder
+vector<double> LinkedBinaryTree::getConstants() const {
+  vector<double> c;
+  for (auto& p : positions())
+    if (isConstant(p.v)) c.push_back(p.v->val);
+  return c;
+}
+
+// set the constant leaves, in preorder, to the values in c. The tree's
+// output changes everywhere, so its action traces are dropped.
+void LinkedBinaryTree::setConstants(const vector<double>& c) {
+  size_t k = 0;
+  for (auto& p : positions())
+    if (isConstant(p.v)) setConstant(p.v, c[k++]);
+  setTraces({});
+}
+
+void LinkedBinaryTree::clearMutations() {
+  mutations.clear();
+}
+
+// true if the tree's output at (a, b) is the one it had when its traces were
+// recorded: every changed place evaluates to what used to be there
+bool LinkedBinaryTree::unchangedAt(double a, double b) const {
+  for (auto& m : mutations) {
+    Node* v = _root;
+    for (char c : m.path) {
+      v = c == 'l' ? v->left : v->right;
+      if (v == NULL) return false;  // the path was folded away by prune()
+    }
+    if (evaluateExpression(Position(v), a, b) !=
+        evaluateExpression(Position(m.old.get()), a, b))
+      return false;
+  }
+  return true;
+}
+
+// nodes held by mutation records
+long LinkedBinaryTree::mutationNodes() const {
+  long n = 0;
+  for (auto& m : mutations) n += size(m.old.get());
+  return n;
+}
+
 // return a list of all nodes
 LinkedBinaryTree::PositionList LinkedBinaryTree::positions() const {
   PositionList pl;
-  preorder(_root, pl);
+  if (_root != NULL) preorder(_root, pl);
   return PositionList(pl);
 }
 
@@ -233,6 +494,7 @@ LinkedBinaryTree::Node* LinkedBinaryTree::copyPreOrder(const Node* root) {
   if (root == NULL) return NULL;
   Node* nn = new Node;
   nn->elt = root->elt;
+  nn->val = root->val;
   nn->left = copyPreOrder(root->left);
   if (nn->left != NULL) nn->left->par = nn;
   nn->right = copyPreOrder(root->right);
@@ -266,6 +528,38 @@ void LinkedBinaryTree::printExpression(Node *v)
   }
 }
 
+// write the subtree at v as a C++ expression in a and b, using the guarded
+// operator functions emitted by exportController
+void LinkedBinaryTree::exportExpression(Node* v, ostream& os) const {
+  if (Position(v).isExternal()) {
+    if (v->elt == "a" || v->elt == "b")
+      os << v->elt;
+    else
+      os << hexfloat << v->val << defaultfloat;  // exact literal
+  } else {
+    if (v->elt == "+")
+      os << "add(";
+    else if (v->elt == "-")
+      os << "sub(";
+    else if (v->elt == "*")
+      os << "mul(";
+    else if (v->elt == "/")
+      os << "div(";
+    else if (v->elt == ">")
+      os << "gt(";
+    else if (v->elt == "abs")
+      os << "abs(";
+    else
+      os << "zero(";  // evalOp returns 0 for unknown operators
+    exportExpression(v->left, os);
+    if (arity(v->elt) > 1) {
+      os << ", ";
+      exportExpression(v->right, os);
+    }
+    os << ")";
+  }
+}
+
 double evalOp(string op, double x, double y = 0) {
   double result;
   if (op == "+")
@@ -285,8 +579,52 @@ double evalOp(string op, double x, double y = 0) {
   return isnan(result) || !isfinite(result) ? 0 : result;
 }
 
+// interval counterpart of evalOp: a range containing evalOp(op, x, y) for
+// every x in X and y in Y. Round-to-nearest is monotone in each operand, so
+// bounds computed with the same operations as evalOp are sound without
+// directed rounding. Wherever an operation can overflow or produce NaN,
+// evalOp returns 0, so 0 is added to the range.
+Interval evalOpInterval(string op, const Interval& X, const Interval& Y = 0) {
+  const double inf = numeric_limits<double>::infinity();
+  Interval r;
+  if (op == "+") {
+    r = Interval(X.lo + Y.lo, X.hi + Y.hi);
+  } else if (op == "-") {
+    r = Interval(X.lo - Y.hi, X.hi - Y.lo);
+  } else if (op == "*" || op == "/") {
+    if (op == "/" && Y.isPoint() && Y.lo == 0) return 0;  // x/0 is never finite
+    if (op == "/" && Y.lo <= 0 && Y.hi >= 0) return Interval(-inf, inf);
+    double c[4];
+    c[0] = op == "*" ? X.lo * Y.lo : X.lo / Y.lo;
+    c[1] = op == "*" ? X.lo * Y.hi : X.lo / Y.hi;
+    c[2] = op == "*" ? X.hi * Y.lo : X.hi / Y.lo;
+    c[3] = op == "*" ? X.hi * Y.hi : X.hi / Y.hi;
+    for (auto& x : c)
+      if (isnan(x)) return Interval(-inf, inf);  // 0 * inf
+    r = Interval(*min_element(c, c + 4), *max_element(c, c + 4));
+  } else if (op == ">") {
+    if (X.lo > Y.hi)
+      return 1;
+    else if (X.hi <= Y.lo)
+      return -1;
+    return Interval(-1, 1);
+  } else if (op == "abs") {
+    if (X.lo >= 0)
+      r = X;
+    else if (X.hi <= 0)
+      r = Interval(-X.hi, -X.lo);
+    else
+      r = Interval(0, max(-X.lo, X.hi));
+  } else
+    return 0;
+  if (isnan(r.lo) || isnan(r.hi)) return Interval(-inf, inf);  // inf - inf
+  if (!isfinite(r.lo) || !isfinite(r.hi))
+    r = Interval(min(r.lo, 0.0), max(r.hi, 0.0));
+  return r;
+}
+
 double LinkedBinaryTree::evaluateExpression(const Position& p, double a,
-                                            double b) {
+                                            double b) const {
   if (!p.isExternal()) {
     auto x = evaluateExpression(p.left(), a, b);
     if (arity(p.v->elt) > 1) {
@@ -301,8 +639,117 @@ double LinkedBinaryTree::evaluateExpression(const Position& p, double a,
     else if (p.v->elt == "b")
       return b;
     else
-      return stod(p.v->elt);
+      return p.v->val;
+  }
+}
+
+// range of the subtree rooted at v when a and b vary over the given ranges
+Interval LinkedBinaryTree::range(Node* v, const Interval& a,
+                                 const Interval& b) const {
+  if (!Position(v).isExternal()) {
+    Interval x = range(v->left, a, b);
+    if (arity(v->elt) > 1)
+      return evalOpInterval(v->elt, x, range(v->right, a, b));
+    return evalOpInterval(v->elt, x);
+  } else {
+    if (v->elt == "a")
+      return a;
+    else if (v->elt == "b")
+      return b;
+    else
+      return v->val;
+  }
+}
+
+// true if the action evaluate() derives from this tree is the same for every
+// input in the given ranges, with that action in action. evaluate() truncates
+// the output to an int and pushes left when it is negative, i.e. when the
+// output is at most -1; outputs beyond the int range are never proven fixed.
+bool LinkedBinaryTree::constantAction(const Interval& a, const Interval& b,
+                                      int& action) const {
+  const double intMax = numeric_limits<int>::max();
+  Interval r = range(a, b);
+  if (r.lo > -1 && r.hi <= intMax) {
+    action = 1;
+    return true;
+  } else if (r.hi <= -1 && r.lo >= -intMax) {
+    action = -1;
+    return true;
   }
+  return false;
+}
+
+// Replace every operator subtree whose value is fixed over the given ranges
+// (including > nodes whose comparison is decided) with that constant, and the
+// whole tree with "1" or "-1" when its action is fixed. Returns the range of
+// the subtree rooted at v. Values and actions over the ranges are unchanged,
+// so mutation records stay valid.
+Interval LinkedBinaryTree::prune(Node* v, const Interval& a,
+                                 const Interval& b) {
+  Interval r;
+  if (Position(v).isExternal()) return range(v, a, b);
+  Interval x = prune(v->left, a, b);
+  if (arity(v->elt) > 1)
+    r = evalOpInterval(v->elt, x, prune(v->right, a, b));
+  else
+    r = evalOpInterval(v->elt, x);
+
+  int action;
+  if (v == _root && constantAction(a, b, action))
+    r = action;
+  if (!r.isPoint()) return r;
+
+  delete v->left;
+  delete v->right;
+  v->left = NULL;
+  v->right = NULL;
+  setConstant(v, r.lo);
+  return r;
+}
+
+// evaluateExpression for many states at once: out[i] is the output at
+// (a[i], b[i]). Each node's operator is dispatched once for the whole batch.
+// If c is not empty, the k-th constant leaf (in getConstants() order) takes
+// the value c[k][i] in lane i instead of its own, so many constant vectors
+// can be evaluated in one pass; k counts the constants visited so far.
+void LinkedBinaryTree::evaluateBatch(Node* v, const vector<double>& a,
+                                     const vector<double>& b,
+                                     const vector<vector<double>>& c, int& k,
+                                     vector<double>& out) const {
+  size_t n = a.size();
+  out.resize(n);
+  if (Position(v).isExternal()) {
+    if (v->elt == "a")
+      out = a;
+    else if (v->elt == "b")
+      out = b;
+    else if (!c.empty())
+      out = c[k++];
+    else
+      out.assign(n, v->val);
+    return;
+  }
+  vector<double> y;
+  evaluateBatch(v->left, a, b, c, k, out);
+  if (arity(v->elt) > 1) evaluateBatch(v->right, a, b, c, k, y);
+  const string& op = v->elt;
+  if (op == "+")
+    for (size_t i = 0; i < n; i++) out[i] = out[i] + y[i];
+  else if (op == "-")
+    for (size_t i = 0; i < n; i++) out[i] = out[i] - y[i];
+  else if (op == "*")
+    for (size_t i = 0; i < n; i++) out[i] = out[i] * y[i];
+  else if (op == "/")
+    for (size_t i = 0; i < n; i++) out[i] = out[i] / y[i];
+  else if (op == ">")
+    for (size_t i = 0; i < n; i++) out[i] = out[i] > y[i] ? 1 : -1;
+  else if (op == "abs")
+    for (size_t i = 0; i < n; i++) out[i] = abs(out[i]);
+  else
+    out.assign(n, 0);
+  // same guard as evalOp
+  for (size_t i = 0; i < n; i++)
+    if (isnan(out[i]) || !isfinite(out[i])) out[i] = 0;
 }
 
 void LinkedBinaryTree::Crossover(mt19937 &rng, LinkedBinaryTree &P1, LinkedBinaryTree &P2)
@@ -369,30 +816,17 @@ void LinkedBinaryTree::Crossover(mt19937 &rng, LinkedBinaryTree &P1, LinkedBinar
   }
 
   if(pos1.v != NULL && pos2.v != NULL && pos1.v->depth() == pos2.v->depth()){//Only crossover if the nodes are not null, AND the depths are equal (to ensure max depth is not exceeded in either parent)
-    Position parent1 = pos1.parent();
-    Position parent2 = pos2.parent();
+    Node* parent1 = pos1.v->par;
+    Node* parent2 = pos2.v->par;
 
-    Node* temp = copyPreOrder(pos1.v);//Copy a subtree into a temporary node as the subtree root, then use this for the swap.
-
-    if (parent1.left().v == pos1.v)
-    {
-      parent1.setLeft(pos2.v);
-    }
-    else
-    {
-      parent1.setRight(pos2.v);
-    }
+    P1.setTraces({});//Relinking is not tracked by mutation records, so any recorded traces no longer apply
+    P2.setTraces({});
 
-    if (parent2.left().v == pos2.v)
-    {
-      parent2.setLeft(temp);
-    }
-    else
-    {
-      parent2.setRight(temp);
-    }
-    pos2.parent() = parent1.v;
-    pos1.parent() = parent2.v;
+    //Swap the two subtrees by relinking them, so each parent takes ownership of the other's subtree and nothing is copied or orphaned
+    (parent1->left == pos1.v ? parent1->left : parent1->right) = pos2.v;
+    (parent2->left == pos2.v ? parent2->left : parent2->right) = pos1.v;
+    pos2.v->par = parent1;
+    pos1.v->par = parent2;
   }
 }
 
@@ -424,34 +858,10 @@ void LinkedBinaryTree::deleteSubtreeMutator(mt19937& rng) {
   }
 
   if(STRoot != nullptr){//Deletion will only occur if the selected node is not NULL (slightly redundant to have this condition, but good practice for defensive programming)
-    PositionList subtree;
-    preorder(pos.v, subtree);//Assigning all positions to the selected node past its current depth, originating from the node itself
-    Position parent = pos.parent();
-
-    if(parent.left().v == pos.v){//Condition to check if the STRoot is the left or right child of its parent
-      parent.setLeft(new Node); //Creating new node to store an operand (in place of the STRoot node)
-        if(randChoice(rng)){
-          parent.left().v->elt = "b";
-        }
-        else{
-          parent.left().v->elt = "a";
-        }
-    }
-    else{//STRoot is the right child of its parent
-      parent.setRight(new Node);
-      if (randChoice(rng)) 
-      {
-        parent.right().v->elt = "a";
-      }
-      else
-      {
-        parent.right().v->elt = "b";
-      }
-    }
+    Node* leaf = new Node; //Creating new node to store an operand (in place of the STRoot node)
+    setTerminal(leaf, randTerminal(rng));
 
-    for (auto& p : subtree){//Deletion of the subtree
-      delete p.v;
-    }
+    replaceSubtree(pos, leaf);//Deletion of the subtree
   } 
 }
 
@@ -489,22 +899,27 @@ void LinkedBinaryTree::addSubtreeMutator(mt19937 &rng, const int maxDepth)
   if (STRoot != nullptr)
   {
     LinkedBinaryTree SubTree = createRandExpressionTree((maxDepth - pos.v->depth()), rng);//Creating a subtree which will not cause the main tree to exceed the max depth
-    if(!pos.isRoot()){ //Check to make sure that the STRoot is itself not the root of the host tree
-      Position Parent = pos.parent();
-      if(Parent.left().v == pos.v){//Condition to check if the STRoot is the left or right child of parent node
-        addLeftChild(Parent,SubTree.root());
-      }
-      else{
-        addRightChild(Parent,SubTree.root());
-      }
-    }
-    else{
-      pos = SubTree.root(); //In the case of the STRoot being the root of the parent tree, we make the STRoot the new root of the host tree
-    }
+    replaceSubtree(pos, SubTree.release()); //The new subtree takes the place of the STRoot leaf (which is deleted), becoming the new root of the host tree if the STRoot was the root
   }
   
 }
 
+// Perturb one randomly chosen constant leaf by Gaussian noise with standard
+// deviation sigma. The leaf is replaced rather than edited in place so that
+// the change is recorded like any other mutation. Returns false, and does
+// nothing, if the tree has no constants.
+bool LinkedBinaryTree::constantMutator(mt19937& rng, const double& sigma) {
+  vector<Node*> leaves;
+  for (auto& p : positions())
+    if (isConstant(p.v)) leaves.push_back(p.v);
+  if (leaves.empty()) return false;
+  Node* v = leaves[randInt(rng, 0, leaves.size() - 1)];
+  Node* leaf = new Node;
+  setConstant(leaf, v->val + std::normal_distribution<>{0, sigma}(rng));
+  replaceSubtree(Position(v), leaf);
+  return true;
+}
+
 bool operator<(const LinkedBinaryTree& x, const LinkedBinaryTree& y) {
   return x.getScore() < y.getScore();
 }
@@ -542,12 +957,7 @@ LinkedBinaryTree createRandExpressionTree(int max_depth, mt19937& rng) {
   LinkedBinaryTree t; //Creating a new tree
   int Ubound = randInt(rng, 0, max_depth); //Determining the upper bound of the random tree's depth
   if (Ubound == 0){ //If the new tree has a depth of 0, only one of the operands needs to be appended to the tree string
-    if (randChoice(rng)){
-      tree.append("a");
-    }
-    else{
-      tree.append("b");
-    }
+    tree.append(randTerminal(rng));
     t = createExpressionTree(tree); //Tree is created, as no more nodes need to be added
     return t;
   }
@@ -558,12 +968,7 @@ LinkedBinaryTree createRandExpressionTree(int max_depth, mt19937& rng) {
   
   while (CurrentPos < Ubound){ 
     if (CurrentPos == 0 && Decision == 0 && Ubound != 0){// First term of a non-zero depth tree
-      if (randChoice(rng)){
-        tree.append("a");
-      }
-      else{
-        tree.append("b");
-      }
+      tree.append(randTerminal(rng));
       if(randChoice(rng)){ //After first operand of the tree, either abs or another operand can be added to the tree
         Decision = 1;
       }
@@ -573,12 +978,7 @@ LinkedBinaryTree createRandExpressionTree(int max_depth, mt19937& rng) {
     }
     else{
       if (Decision == 1){//Adding an operand to the tree. The depth counter (CurrentPos) does not need to be incrememnted, as this node will be at the same depth as the node prior to it
-        if (randChoice(rng)){
-          tree.append(" a");
-        }
-        else{
-          tree.append(" b");
-        }
+        tree.append(" " + randTerminal(rng));
         Decision = 2; //Two operands have been added sequentially to the string, so a non-abs operator needs to be next
       }
       else if (Decision == 2){//A non-abs operator needs to be next
@@ -618,20 +1018,49 @@ LinkedBinaryTree createRandExpressionTree(int max_depth, mt19937& rng) {
   return t; //Return the expression tree of a non-zero depth
 }
 
-// evaluate tree t in the cart centering task
+// ranges of the policy inputs a (position) and b (velocity) over all
+// non-terminal states: the track ends at MAX_X and velocity is clamped
+Interval stateDomainX() {
+  cartCentering env;
+  return Interval(-env.getMaxX(), env.getMaxX());
+}
+Interval stateDomainV() {
+  cartCentering env;
+  return Interval(-env.getMaxV(), env.getMaxV());
+}
+
+// evaluate tree t in the cart centering task, querying it every
+// action_repeat steps and holding its action in between
 void evaluate(mt19937& rng, LinkedBinaryTree& t, const int& num_episode,
-              bool animate) {
+              bool animate, const int& action_repeat = 1) {
   cartCentering env;
   double mean_score = 0.0;
   double mean_steps = 0.0;
+
+  // a tree whose action is provably constant is scored in closed form; this
+  // agrees with stepping it one update() at a time up to rounding, well
+  // inside the tolerance LexLessThan compares scores with
+  int fixed_action;
+  bool analytic =
+      !animate && t.constantAction(stateDomainX(), stateDomainV(), fixed_action);
+
   for (int i = 0; i < num_episode; i++) {
     double episode_score = 0.0;
     int episode_steps = 0;
     env.reset(rng);
+    if (analytic)
+      episode_score = env.advance(fixed_action, numeric_limits<int>::max(),
+                                  episode_steps);
     while (!env.terminal()) {
       int action = t.evaluateExpression(env.getCartXPos(), env.getCartXVel());
-      episode_score += env.update(action, animate);
-      episode_steps++;
+      if (action_repeat > 1 && !animate) {
+        int taken;
+        episode_score += env.advance(action, action_repeat, taken);
+        episode_steps += taken;
+      } else {
+        episode_score += env.update(action, animate);
+        episode_steps++;
+      }
     }
     mean_score += episode_score;
     mean_steps += episode_steps;
@@ -640,6 +1069,599 @@ void evaluate(mt19937& rng, LinkedBinaryTree& t, const int& num_episode,
   t.setSteps(mean_steps / num_episode);
 }
 
+// Local search over the constants of tree t. Each round draws num_episode
+// start states and candidates perturbed copies of the current constant
+// vector (the first is left unchanged), with Gaussian noise of standard
+// deviation sigma times the size of each constant (at least sigma). All
+// candidates are simulated from the same start states in lockstep, one
+// batched evaluation of the tree per step for every unfinished episode, and
+// the candidate with the best mean reward becomes the current vector.
+// Returns true and updates t's constants if any round found an improvement;
+// t must then be re-scored.
+bool tuneConstants(mt19937& rng, LinkedBinaryTree& t, const int& num_episode,
+                   const int& candidates, const double& sigma,
+                   const int& rounds) {
+  vector<double> best = t.getConstants();
+  if (best.empty()) return false;
+  const size_t nc = best.size();
+  const size_t lanes = (size_t)candidates * num_episode;
+  bool improved = false;
+  std::normal_distribution<> noise(0, 1);
+
+  for (int r = 0; r < rounds; r++) {
+    // cand[j][k] is constant k of candidate j
+    vector<vector<double>> cand(candidates, best);
+    for (int j = 1; j < candidates; j++)
+      for (size_t k = 0; k < nc; k++)
+        cand[j][k] += sigma * max(1.0, abs(best[k])) * noise(rng);
+
+    // lane i runs candidate i / num_episode from start i % num_episode
+    vector<cartCentering> envs(lanes);
+    cartCentering start;
+    for (int e = 0; e < num_episode; e++) {
+      start.reset(rng);
+      for (int j = 0; j < candidates; j++)
+        envs[j * num_episode + e].reset(start.getCartXPos(),
+                                        start.getCartXVel());
+    }
+    vector<double> score(candidates, 0.0);
+    vector<size_t> active(lanes);
+    for (size_t i = 0; i < lanes; i++) active[i] = i;
+    vector<double> a, b, out;
+    vector<vector<double>> c(nc);
+    while (!active.empty()) {
+      a.clear();
+      b.clear();
+      for (auto& ck : c) ck.clear();
+      for (auto i : active) {
+        a.push_back(envs[i].getCartXPos());
+        b.push_back(envs[i].getCartXVel());
+        for (size_t k = 0; k < nc; k++)
+          c[k].push_back(cand[i / num_episode][k]);
+      }
+      t.evaluateBatch(a, b, c, out);
+      size_t still = 0;
+      for (size_t n = 0; n < active.size(); n++) {
+        size_t i = active[n];
+        int action = out[n];
+        score[i / num_episode] += envs[i].update(action);
+        if (!envs[i].terminal()) active[still++] = i;
+      }
+      active.resize(still);
+    }
+
+    int j = max_element(score.begin(), score.end()) - score.begin();
+    if (score[j] > score[0]) {
+      best = cand[j];
+      improved = true;
+    }
+  }
+  if (improved) t.setConstants(best);
+  return improved;
+}
+
+// counts of how much simulation prefix reuse saved
+struct ReuseStats {
+  long steps = 0;     // steps simulated
+  long replayed = 0;  // steps taken while following the parent's trace
+  long skipped = 0;   // tree evaluations skipped while following
+  long trees = 0;     // trees evaluated on the bank
+  long timed = 0;     // trees also evaluated afresh, for timing
+  double reuse_seconds = 0.0;  // time of the timed trees' evaluations...
+  double fresh_seconds = 0.0;  // ...and of the same trees without traces
+};
+
+// Evaluate tree t from each start state in bank, recording its action
+// traces. If t carries traces from its parent, each episode follows the
+// parent's trajectory while the child agrees with it: the child's action is
+// the parent's recorded one wherever its changed places evaluate to what
+// used to be there, and the tree is evaluated otherwise. From the first step
+// where the actions differ, the episode is simulated normally.
+void evaluateBank(LinkedBinaryTree& t, const vector<pair<double, double>>& bank,
+                  ReuseStats& stats) {
+  stats.trees++;
+  cartCentering env;
+  bool reuse = t.getTraces().size() == bank.size();
+  vector<ActionTrace> traces(bank.size());
+  double mean_score = 0.0;
+  double mean_steps = 0.0;
+  for (size_t i = 0; i < bank.size(); i++) {
+    double episode_score = 0.0;
+    bool following = reuse;
+    env.reset(bank[i].first, bank[i].second);
+    while (!env.terminal()) {
+      double x = env.getCartXPos(), v = env.getCartXVel();
+      int action;
+      if (following && t.unchangedAt(x, v)) {
+        action = t.getTraces()[i].left(traces[i].steps) ? -1 : 1;
+        stats.skipped++;
+      } else {
+        action = t.evaluateExpression(x, v);
+        if (following)
+          following = (action < 0) == t.getTraces()[i].left(traces[i].steps);
+      }
+      if (following) stats.replayed++;
+      traces[i].push(action < 0);
+      episode_score += env.update(action);
+    }
+    stats.steps += traces[i].steps;
+    mean_score += episode_score;
+    mean_steps += traces[i].steps;
+  }
+  t.setScore(mean_score / bank.size());
+  t.setSteps(mean_steps / bank.size());
+  t.setTraces(traces);
+}
+
+// evaluateBank, timed against evaluating a copy of t without its parent's
+// traces on the same bank
+void timeBank(LinkedBinaryTree& t, const vector<pair<double, double>>& bank,
+              ReuseStats& stats) {
+  LinkedBinaryTree fresh(t);
+  fresh.setTraces({});
+  ReuseStats unused;
+  auto start = chrono::steady_clock::now();
+  evaluateBank(t, bank, stats);
+  auto mid = chrono::steady_clock::now();
+  evaluateBank(fresh, bank, unused);
+  auto end = chrono::steady_clock::now();
+  stats.timed++;
+  stats.reuse_seconds += chrono::duration<double>(mid - start).count();
+  stats.fresh_seconds += chrono::duration<double>(end - mid).count();
+}
+
+// Scores trees by behaviour rather than structure. A tree's fingerprint is
+// its decision (push left or right) on a fixed set of probe states; a tree
+// whose fingerprint matches an already scored tree inherits that tree's
+// score and steps instead of being simulated. Every audit_interval-th
+// inheritance is audited by simulating both trees from the same start states
+// (the episode bank, if the population is scored on one) and counting a disagreement if any episode ends differently; the audited
+// tree then keeps the score of its audit run and replaces the cached tree.
+// The cache keeps the most recent capacity scored trees.
+class FitnessCache {
+ public:
+  FitnessCache(const int& num_probe, const int& audit_interval,
+               const int& capacity)
+      : audit_interval(audit_interval),
+        capacity(capacity),
+        audit_rng(1),
+        evaluated(0),
+        inherited(0),
+        audits(0),
+        disagreements(0) {
+    // Probe states are sampled from states visited in recorded episodes of a
+    // noisy bang-bang controller, which switches on x + gain * v * |v| = 0
+    // with a random gain per episode and flips a tenth of its actions.
+    // Episodes stay at small velocities, so probes drawn uniformly over the
+    // state domain would mostly describe states that are never visited.
+    mt19937 probe_rng(0);
+    cartCentering env;
+    vector<pair<double, double>> visited;
+    while (visited.size() < 100000) {
+      env.reset(probe_rng);
+      double gain = 0.5 + 1.5 * randDouble(probe_rng);
+      while (!env.terminal()) {
+        double x = env.getCartXPos(), v = env.getCartXVel();
+        visited.push_back({x, v});
+        int action = x + gain * v * abs(v) > 0 ? -1 : 1;
+        if (randDouble(probe_rng) < 0.1) action = -action;
+        env.update(action);
+      }
+    }
+    for (int i = 0; i < num_probe; i++)
+      probes.push_back(visited[randInt(probe_rng, 0, visited.size() - 1)]);
+  }
+
+  // set t's score and steps from a behaviourally identical scored tree;
+  // returns false if there is none. Audits use the start states in bank,
+  // or num_episode random ones queried every action_repeat steps if it is
+  // empty.
+  bool inherit(LinkedBinaryTree& t, const int& num_episode,
+               const int& action_repeat,
+               const vector<pair<double, double>>& bank) {
+    evaluated++;
+    string key = fingerprint(t);
+    auto it = cache.find(key);
+    if (it == cache.end()) return false;
+    LinkedBinaryTree& match = it->second;
+    inherited++;
+    if (audit_interval > 0 && inherited % audit_interval == 0) {
+      audits++;
+      if (!sameOutcomes(t, match, num_episode, action_repeat, bank)) {
+        // the cached score is wrong for t: keep t's audit score instead
+        disagreements++;
+        cache.erase(it);
+        order.erase(find(order.begin(), order.end(), key));
+        insert(t);
+        return true;
+      }
+    }
+    t.setScore(match.getScore());
+    t.setSteps(match.getSteps());
+    return true;
+  }
+
+  // remember scored tree t
+  void insert(const LinkedBinaryTree& t) {
+    string key = fingerprint(t);
+    if (cache.count(key)) return;
+    cache.emplace(key, t);
+    order.push_back(key);
+    if ((int)order.size() > capacity) {
+      cache.erase(order.front());
+      order.pop_front();
+    }
+  }
+
+  void clear() {
+    cache.clear();
+    order.clear();
+  }
+
+  // nodes held by cached trees
+  long nodes() const {
+    long n = 0;
+    for (auto& e : cache) n += e.second.size() + e.second.mutationNodes();
+    return n;
+  }
+
+  void printStats() const {
+    std::cout << "Fitness inheritance: " << inherited << " of " << evaluated
+              << " evaluations ("
+              << (evaluated > 0 ? 100.0 * inherited / evaluated : 0.0)
+              << "%), " << audits << " audits, " << disagreements
+              << " disagreements" << std::endl;
+  }
+
+ private:
+  // decisions on the probe states packed eight to a character
+  string fingerprint(const LinkedBinaryTree& t) const {
+    string key((probes.size() + 7) / 8, 0);
+    for (size_t i = 0; i < probes.size(); i++) {
+      int action = t.evaluateExpression(probes[i].first, probes[i].second);
+      if (action < 0) key[i / 8] |= 1 << (i % 8);
+    }
+    return key;
+  }
+
+  // true if a and b end every episode from the same start states
+  // identically; a keeps the score of its run
+  bool sameOutcomes(LinkedBinaryTree& a, LinkedBinaryTree b,
+                    const int& num_episode, const int& action_repeat,
+                    const vector<pair<double, double>>& bank) {
+    if (!bank.empty()) {
+      ReuseStats unused;
+      evaluateBank(a, bank, unused);
+      evaluateBank(b, bank, unused);
+      return a.getScore() == b.getScore() && a.getSteps() == b.getSteps();
+    }
+    mt19937 rng_b = audit_rng;
+    evaluate(audit_rng, a, num_episode, false, action_repeat);
+    evaluate(rng_b, b, num_episode, false, action_repeat);
+    return a.getScore() == b.getScore() && a.getSteps() == b.getSteps();
+  }
+
+  int audit_interval;
+  int capacity;
+  vector<pair<double, double>> probes;  // (x, v) probe states
+  unordered_map<string, LinkedBinaryTree> cache;
+  deque<string> order;  // insertion order, for eviction
+  mt19937 audit_rng;
+  long evaluated;
+  long inherited;
+  long audits;
+  long disagreements;
+};
+
+// Compare the fitness of tree t when it is queried every 1, 2, 4, ... up to
+// max_repeat steps, from the same start states
+void reportRepeatFidelity(mt19937& rng, const LinkedBinaryTree& t,
+                          const int& num_episode, const int& max_repeat) {
+  mt19937 start = rng;
+  std::cout << "Action repeat fidelity (repeat,fitness,steps,seconds):"
+            << std::endl;
+  for (int k = 1; k <= max_repeat; k *= 2) {
+    LinkedBinaryTree copy(t);
+    rng = start;
+    auto begin = chrono::steady_clock::now();
+    evaluate(rng, copy, num_episode, false, k);
+    double secs =
+        chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    std::cout << k << "," << copy.getScore() << "," << copy.getSteps() << ","
+              << secs << std::endl;
+  }
+}
+
+// Write tree t as a standalone controller: dir/name.h defines namespace
+// name with policy(a, b), the tree's output with evalOp's semantics, and
+// action(a, b), the action evaluate() would take. dir/nameTest.cpp checks
+// policy() against this interpreter's outputs on a 129 x 129 grid over the
+// state domain, stored in the test. Grid coordinates are exact multiples of
+// a power-of-two fraction of the domain, so both sides see the same inputs.
+void exportController(const LinkedBinaryTree& t, const string& name,
+                      const string& dir) {
+  filesystem::create_directories(dir);
+  ofstream h(dir + "/" + name + ".h");
+  h << "// Generated by ExecuteCentering from the expression tree" << endl;
+  h << "// Compile without -ffast-math: the guards depend on inf and NaN."
+    << endl;
+  h << "#ifndef " << name << "_h" << endl;
+  h << "#define " << name << "_h" << endl << endl;
+  h << "#include <cmath>" << endl << endl;
+  h << "namespace " << name << " {" << endl << endl;
+  h << "// every operator result that is NaN or infinite becomes 0" << endl;
+  h << "inline double guard(double r) { return std::isfinite(r) ? r : 0; }"
+    << endl;
+  h << "inline double add(double x, double y) { return guard(x + y); }" << endl;
+  h << "inline double sub(double x, double y) { return guard(x - y); }" << endl;
+  h << "inline double mul(double x, double y) { return guard(x * y); }" << endl;
+  h << "inline double div(double x, double y) { return guard(x / y); }" << endl;
+  h << "inline double gt(double x, double y) { return x > y ? 1 : -1; }"
+    << endl;
+  h << "inline double abs(double x) { return guard(std::fabs(x)); }" << endl;
+  h << "inline double zero(double, double = 0) { return 0; }" << endl << endl;
+  h << "// tree output for position a and velocity b" << endl;
+  h << "inline double policy(double a, double b) {" << endl;
+  h << "  return ";
+  t.exportExpression(h);
+  h << ";" << endl << "}" << endl << endl;
+  h << "// action as passed to cartCentering::update (negative pushes left)"
+    << endl;
+  h << "inline int action(double a, double b) { return (int)policy(a, b); }"
+    << endl << endl;
+  h << "}  // namespace " << name << endl;
+  h << "#endif" << endl;
+
+  const int n = 129;
+  ofstream c(dir + "/" + name + "Test.cpp");
+  c << "// Generated by ExecuteCentering: checks " << name << ".h against the"
+    << endl;
+  c << "// expression tree interpreter on a " << n << " x " << n
+    << " grid of states" << endl;
+  c << "#include <iostream>" << endl << endl;
+  c << "#include \"" << name << ".h\"" << endl << endl;
+  c << "const double expected[" << n * n << "] = {" << endl << hexfloat;
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++) {
+      double a = stateDomainX().lo + i * (stateDomainX().hi * 2 / (n - 1));
+      double b = stateDomainV().lo + j * (stateDomainV().hi * 2 / (n - 1));
+      c << "  " << t.evaluateExpression(a, b) << "," << endl;
+    }
+  c << "};" << endl << endl << defaultfloat;
+  c << "int main() {" << endl;
+  c << "  int mismatches = 0;" << endl;
+  c << "  for (int i = 0; i < " << n << "; i++)" << endl;
+  c << "    for (int j = 0; j < " << n << "; j++) {" << endl;
+  c << "      double a = " << hexfloat << stateDomainX().lo << " + i * "
+    << stateDomainX().hi * 2 / (n - 1) << ";" << endl;
+  c << "      double b = " << stateDomainV().lo << " + j * "
+    << stateDomainV().hi * 2 / (n - 1) << defaultfloat << ";" << endl;
+  c << "      if (" << name << "::policy(a, b) != expected[i * " << n
+    << " + j]) mismatches++;" << endl;
+  c << "    }" << endl;
+  c << "  std::cout << mismatches << \" mismatches in " << n * n
+    << " states\" << std::endl;" << endl;
+  c << "  return mismatches == 0 ? 0 : 1;" << endl;
+  c << "}" << endl;
+}
+
+// Run tree t from many start states across all cores and report how it
+// copes: a success map, the distribution of steps to the centre, and the
+// worst start states. Starts are either a grid x grid lattice over
+// [lo, hi]^2 or, if samples > 0, that many uniform samples from it. Each
+// thread runs its starts in batches of environments, evaluating the tree
+// for every active environment of a batch in one pass.
+//
+// Writes <prefix>.pgm, the fraction of solved starts in each of
+// bins x bins cells (white = all solved), and <prefix>_worst.csv, the
+// num_worst starts with the lowest reward.
+void robustnessSweep(const LinkedBinaryTree& t, const double& lo,
+                     const double& hi, const int& grid, const long& samples,
+                     const int& bins, const int& num_worst,
+                     const string& prefix) {
+  struct Start {
+    double x, v;
+    double reward;
+    int steps;
+    bool solved;
+  };
+  vector<Start> starts;
+  if (samples > 0) {
+    mt19937 sample_rng(0);
+    uniform_real_distribution<> dis(lo, hi);
+    for (long i = 0; i < samples; i++) {
+      double x = dis(sample_rng);
+      starts.push_back({x, dis(sample_rng), 0, 0, false});
+    }
+  } else {
+    for (int i = 0; i < grid; i++)
+      for (int j = 0; j < grid; j++)
+        starts.push_back({lo + (hi - lo) * (i + 0.5) / grid,
+                          lo + (hi - lo) * (j + 0.5) / grid, 0, 0, false});
+  }
+
+  const size_t batch = 1024;
+  auto start_time = chrono::steady_clock::now();
+  auto run = [&](size_t begin, size_t end) {
+    vector<double> a, b, out;
+    vector<size_t> active;
+    for (size_t first = begin; first < end; first += batch) {
+      size_t last = min(first + batch, end);
+      vector<cartCentering> envs(last - first);
+      active.clear();
+      for (size_t i = first; i < last; i++) {
+        envs[i - first].reset(starts[i].x, starts[i].v);
+        if (envs[i - first].terminal())
+          starts[i].reward = envs[i - first].reward();  // e.g. off the track
+        else
+          active.push_back(i - first);
+      }
+      while (!active.empty()) {
+        a.clear();
+        b.clear();
+        for (auto k : active) {
+          a.push_back(envs[k].getCartXPos());
+          b.push_back(envs[k].getCartXVel());
+        }
+        t.evaluateBatch(a, b, out);
+        size_t still = 0;
+        for (size_t i = 0; i < active.size(); i++) {
+          size_t k = active[i];
+          int action = out[i];
+          starts[first + k].reward += envs[k].update(action);
+          starts[first + k].steps++;
+          if (!envs[k].terminal()) active[still++] = k;
+        }
+        active.resize(still);
+      }
+      for (size_t i = first; i < last; i++)
+        starts[i].solved = envs[i - first].solved();
+    }
+  };
+  int num_threads = max(1u, thread::hardware_concurrency());
+  vector<thread> threads;
+  size_t per_thread = (starts.size() + num_threads - 1) / num_threads;
+  for (int i = 0; i < num_threads; i++) {
+    size_t begin = min(starts.size(), i * per_thread);
+    threads.emplace_back(run, begin, min(starts.size(), begin + per_thread));
+  }
+  for (auto& th : threads) th.join();
+  double secs =
+      chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+
+  // success map
+  vector<long> solved_in(bins * bins, 0), total_in(bins * bins, 0);
+  for (auto& st : starts) {
+    int i = min(bins - 1, max(0, (int)((st.x - lo) / (hi - lo) * bins)));
+    int j = min(bins - 1, max(0, (int)((st.v - lo) / (hi - lo) * bins)));
+    // rows run from high to low velocity, columns from low to high position
+    int cell = (bins - 1 - j) * bins + i;
+    total_in[cell]++;
+    solved_in[cell] += st.solved;
+  }
+  ofstream pgm(prefix + ".pgm", ios::binary);
+  pgm << "P5\n" << bins << " " << bins << "\n255\n";
+  for (int c = 0; c < bins * bins; c++)
+    pgm.put(total_in[c] ? (char)(255 * solved_in[c] / total_in[c]) : 0);
+
+  // steps to the centre
+  vector<int> steps;
+  for (auto& st : starts)
+    if (st.solved) steps.push_back(st.steps);
+  sort(steps.begin(), steps.end());
+  std::cout << "Sweep: " << starts.size() << " starts over [" << lo << ", "
+            << hi << "]^2 in " << secs << " s on " << num_threads
+            << " threads" << std::endl;
+  std::cout << "Solved: " << steps.size() << " ("
+            << 100.0 * steps.size() / starts.size() << "%)" << std::endl;
+  if (!steps.empty()) {
+    auto pct = [&](double p) { return steps[(size_t)(p * (steps.size() - 1))]; };
+    std::cout << "Steps to centre: median " << pct(0.5) << ", p90 "
+              << pct(0.9) << ", p99 " << pct(0.99) << ", max " << steps.back()
+              << std::endl;
+    std::cout << "Steps histogram (bucket,count):" << std::endl;
+    const int bucket = 50;
+    for (int lo_step = 0; lo_step <= steps.back(); lo_step += bucket) {
+      long count = lower_bound(steps.begin(), steps.end(), lo_step + bucket) -
+                   lower_bound(steps.begin(), steps.end(), lo_step);
+      std::cout << lo_step << "-" << lo_step + bucket - 1 << "," << count
+                << std::endl;
+    }
+  }
+
+  // worst start states
+  size_t worst = min(starts.size(), (size_t)num_worst);
+  partial_sort(starts.begin(), starts.begin() + worst, starts.end(),
+               [](const Start& p, const Start& q) { return p.reward < q.reward; });
+  ofstream csv(prefix + "_worst.csv");
+  csv << "x,v,reward,steps,solved" << endl;
+  for (size_t i = 0; i < worst; i++)
+    csv << starts[i].x << "," << starts[i].v << "," << starts[i].reward << ","
+        << starts[i].steps << "," << starts[i].solved << endl;
+  std::cout << "Success map written to " << prefix << ".pgm, worst starts to "
+            << prefix << "_worst.csv" << std::endl;
+}
+
+// distill tree t into a decision grid over the state domain
+DecisionGrid distill(LinkedBinaryTree& t, const int& nx, const int& nv,
+                     const int& refine) {
+  cartCentering env;
+  DecisionGrid grid(env.getMaxX(), env.getMaxV(), nx, nv, refine);
+  grid.build([&](double x, double v) {
+    int action = t.evaluateExpression(x, v);
+    return action;
+  });
+  return grid;
+}
+
+// Compare grid control with exact control of tree t from the same start
+// states: how often the grid picks a different action on the states exact
+// control visits, and how that changes episode outcomes.
+void validateGrid(mt19937& rng, LinkedBinaryTree& t, const DecisionGrid& grid,
+                  const int& num_episode) {
+  long states = 0, disagree = 0;
+  int solved_exact = 0, solved_grid = 0, changed = 0;
+  double score_exact = 0.0, score_grid = 0.0;
+  double steps_exact = 0.0, steps_grid = 0.0;
+  for (int i = 0; i < num_episode; i++) {
+    cartCentering exact;
+    exact.reset(rng);
+    cartCentering lookup(exact);
+    while (!exact.terminal()) {
+      double x = exact.getCartXPos(), v = exact.getCartXVel();
+      int action = t.evaluateExpression(x, v);
+      if ((action < 0) != (grid.action(x, v) < 0)) disagree++;
+      states++;
+      score_exact += exact.update(action);
+      steps_exact++;
+    }
+    while (!lookup.terminal()) {
+      score_grid += lookup.update(
+          grid.action(lookup.getCartXPos(), lookup.getCartXVel()));
+      steps_grid++;
+    }
+    solved_exact += exact.solved();
+    solved_grid += lookup.solved();
+    if (exact.solved() != lookup.solved()) changed++;
+  }
+
+  // time both controllers on the same uniformly sampled states
+  const int num_sample = 100000;
+  vector<double> xs, vs;
+  for (int i = 0; i < num_sample; i++) {
+    xs.push_back(stateDomainX().hi * (2 * randDouble(rng) - 1));
+    vs.push_back(stateDomainV().hi * (2 * randDouble(rng) - 1));
+  }
+  long left_exact = 0, left_grid = 0;
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < num_sample; i++)
+    left_exact += (int)t.evaluateExpression(xs[i], vs[i]) < 0;
+  auto mid = chrono::steady_clock::now();
+  for (int i = 0; i < num_sample; i++)
+    left_grid += grid.action(xs[i], vs[i]) < 0;
+  auto end = chrono::steady_clock::now();
+  double ns_exact = chrono::duration<double, nano>(mid - start).count();
+  double ns_grid = chrono::duration<double, nano>(end - mid).count();
+
+  std::cout << "Grid cells: " << grid.getNumCells() << " ("
+            << grid.getNumRefined() << " refined)" << std::endl;
+  std::cout << "Grid memory: " << grid.bytes() << " bytes" << std::endl;
+  std::cout << "Decision disagreement: " << (double)disagree / states << " ("
+            << disagree << " of " << states << " states)" << std::endl;
+  std::cout << "Exact control: fitness " << score_exact / num_episode
+            << ", steps " << steps_exact / num_episode << ", solved "
+            << solved_exact << "/" << num_episode << std::endl;
+  std::cout << "Grid control: fitness " << score_grid / num_episode
+            << ", steps " << steps_grid / num_episode << ", solved "
+            << solved_grid << "/" << num_episode << std::endl;
+  std::cout << "Episodes with changed outcome: " << changed << std::endl;
+  std::cout << "Decision time (ns): exact " << ns_exact / num_sample
+            << ", grid " << ns_grid / num_sample << std::endl;
+  std::cout << "Left decisions on timed states: exact "
+            << (double)left_exact / num_sample << ", grid "
+            << (double)left_grid / num_sample << std::endl;
+}
+
 bool LexLessThan(const LinkedBinaryTree &A, const LinkedBinaryTree &B) //Two different trees need to be passed in as arguments, in order to compare the two
 {
   //Do a comparison between two 
@@ -654,6 +1676,187 @@ bool LexLessThan(const LinkedBinaryTree &A, const LinkedBinaryTree &B) //Two dif
   }
 }
 
+// Fixed-capacity FIFO shared between the breeder and the evaluation workers.
+// push() blocks while full, pop() blocks while empty and returns false once
+// the queue has been closed and drained.
+template <typename T>
+class BoundedQueue {
+ public:
+  BoundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+
+  bool push(const T& item) {
+    unique_lock<mutex> lock(m);
+    notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+    if (closed) return false;
+    items.push(item);
+    notEmpty.notify_one();
+    return true;
+  }
+
+  bool pop(T& item) {
+    unique_lock<mutex> lock(m);
+    notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+    if (items.empty()) return false;
+    item = items.front();
+    items.pop();
+    notFull.notify_one();
+    return true;
+  }
+
+  void close() {
+    lock_guard<mutex> lock(m);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+ private:
+  size_t capacity;
+  bool closed;
+  queue<T> items;
+  mutex m;
+  condition_variable notFull;
+  condition_variable notEmpty;
+};
+
+// Survivor pool kept sorted worst->best by LexLessThan. Trees are inserted as
+// soon as their score is known and the worst are dropped past capacity, so
+// there is never a population-wide sort.
+class RankedPool {
+ public:
+  RankedPool(size_t capacity) : capacity(capacity), inserted(0) {}
+
+  void insert(const LinkedBinaryTree& t) {
+    lock_guard<mutex> lock(m);
+    auto it = upper_bound(trees.begin(), trees.end(), t, LexLessThan);
+    trees.insert(it, t);
+    if (trees.size() > capacity) trees.erase(trees.begin());
+    inserted++;
+    grown.notify_all();
+  }
+
+  // block until at least n trees have been inserted in total
+  void waitForInserted(long n) {
+    unique_lock<mutex> lock(m);
+    grown.wait(lock, [&] { return inserted >= n; });
+  }
+
+  // copy a uniformly chosen survivor; returns false while the pool is empty
+  bool sample(mt19937& rng, LinkedBinaryTree& out) {
+    lock_guard<mutex> lock(m);
+    if (trees.empty()) return false;
+    out = trees[randInt(rng, 0, trees.size() - 1)];
+    return true;
+  }
+
+  LinkedBinaryTree best() {
+    lock_guard<mutex> lock(m);
+    return trees.back();
+  }
+
+ private:
+  size_t capacity;
+  long inserted;  // trees inserted so far, including dropped ones
+  vector<LinkedBinaryTree> trees;
+  mutex m;
+  condition_variable grown;
+};
+
+// Steady-state variant of the generational loop in main(). A breeder thread
+// mutates survivors into a bounded queue while worker threads evaluate
+// children and rank them into the survivor pool as scores arrive. The same
+// number of evaluations as the generational loop is performed; a stats line
+// is printed every NUM_TREE / 2 evaluations (one "generation"). The best
+// survivor is returned in best; returns false if the run was stopped at the
+// node ceiling.
+bool runPipelined(mt19937& rng, vector<LinkedBinaryTree>& trees,
+                  const int& numTree, const int& maxDepth,
+                  const int& numEpisode, const int& maxGenerations,
+                  const double& constantRate, const double& constantSigma,
+                  const long& maxLiveNodes,
+                  const bool& prune, LinkedBinaryTree& best) {
+  const int perGeneration = numTree / 2;
+  const long budget = (long)numTree + (long)(maxGenerations - 1) * perGeneration;
+  int numWorkers = max(1u, thread::hardware_concurrency());
+
+  BoundedQueue<LinkedBinaryTree> pending(2 * numWorkers);
+  RankedPool pool(perGeneration);
+  mutex statsMutex;
+  long evaluated = 0;
+  long bred = trees.size();
+
+  // per-thread generators, seeded from the experiment generator
+  mt19937 breederRng(rng());
+  vector<mt19937> workerRngs;
+  for (int i = 0; i < numWorkers; i++) workerRngs.emplace_back(rng());
+
+  auto worker = [&](int id) {
+    LinkedBinaryTree t;
+    while (pending.pop(t)) {
+      evaluate(workerRngs[id], t, numEpisode, false);
+      pool.insert(t);
+      lock_guard<mutex> lock(statsMutex);
+      evaluated++;
+      if (evaluated >= numTree && (evaluated - numTree) % perGeneration == 0) {
+        LinkedBinaryTree best = pool.best();
+        std::cout << (evaluated - numTree) / perGeneration + 1 << ",";
+        std::cout << best.getScore() << ",";
+        std::cout << best.getSteps() << ",";
+        std::cout << best.size() << ",";
+        std::cout << best.depth() << std::endl;
+      }
+    }
+  };
+
+  vector<thread> workers;
+  for (int i = 0; i < numWorkers; i++) workers.emplace_back(worker, i);
+
+  // initial population goes straight to the workers, and breeding starts
+  // once all of it has been scored, as in the generational loop
+  for (auto& t : trees) pending.push(t);
+  pool.waitForInserted(trees.size());
+
+  // breed until the evaluation budget is spent; children are stamped with
+  // the generation they would have been born in
+  LinkedBinaryTree parent;
+  int rejected = 0;
+  bool ok = true;
+  while (bred < budget && pool.sample(breederRng, parent)) {
+    LinkedBinaryTree child(parent);
+    int g = (bred - numTree) / perGeneration + 1;
+    child.setGeneration(g);
+    if (randDouble(breederRng) >= constantRate ||
+        !child.constantMutator(breederRng, constantSigma)) {
+      child.deleteSubtreeMutator(breederRng);
+      child.addSubtreeMutator(breederRng, maxDepth);
+    }
+    if (prune) child.prune(stateDomainX(), stateDomainV());
+
+    // Drop children that would take the run over its memory ceiling once
+    // the children in flight have been scored, and stop the run after
+    // numTree drops in a row
+    if (LinkedBinaryTree::liveNodes() > maxLiveNodes) {
+      pool.waitForInserted(bred);
+      if (LinkedBinaryTree::liveNodes() > maxLiveNodes) {
+        if (++rejected <= numTree) continue;
+        std::cerr << "Node ceiling of " << maxLiveNodes
+                  << " reached in generation " << g << std::endl;
+        ok = false;
+        break;
+      }
+    }
+    rejected = 0;
+
+    pending.push(child);
+    bred++;
+  }
+  pending.close();
+  for (auto& w : workers) w.join();
+
+  best = pool.best();
+  return ok;
+}
+
 int main() {
   // Experiment parameters
   mt19937 rng(42);
@@ -661,7 +1864,46 @@ int main() {
   const int MAX_DEPTH_INITIAL = 1;
   const int MAX_DEPTH = 20;
   const int NUM_EPISODE = 20;
-  const int MAX_GENERATIONS = 100;
+#ifdef LEAK_CHECK
+  const bool LONG_RUN = true;  // leak regression build, see "make leakcheck"
+  const int LONG_RUN_GENERATIONS = 300;
+#else
+  const bool LONG_RUN = false;  // many generations under the node ceiling
+  const int LONG_RUN_GENERATIONS = 100000;
+#endif
+  const int MAX_GENERATIONS = LONG_RUN ? LONG_RUN_GENERATIONS : 100;
+  const long MAX_LIVE_NODES = 4000000;  // hard ceiling on allocated nodes
+  const bool PIPELINED = false;  // steady-state multithreaded engine
+  const bool INTERVAL_PRUNING = false;  // fold subtrees fixed over the domain
+  const bool INHERIT_FITNESS = false;  // skip simulating neutral mutants
+  const int NUM_PROBE = 256;           // probe states per fingerprint
+  const int AUDIT_INTERVAL = 20;       // audit every n-th inherited score
+  const bool PREFIX_REUSE = false;  // fixed episode bank, replay parents
+  const int REUSE_TIMING = 10;      // time every n-th tree against no reuse
+  const int ACTION_REPEAT = 1;     // query trees every n steps at first...
+  const int REPEAT_HALVING = 20;   // ...halving n every this many generations
+  const bool EXPORT_CONTROLLER = false;  // write best tree as C++ code
+  const bool SWEEP = false;         // robustness sweep of the best tree
+  const double SWEEP_SCALE = 1.0;   // sweep starts over SCALE * initial range
+  const int SWEEP_GRID = 1000;      // grid x grid starts...
+  const long SWEEP_SAMPLES = 0;     // ...or this many random starts if > 0
+  const bool DISTILL = false;  // distill best tree into a decision grid
+  const int GRID_X = 256;      // grid cells along x
+  const int GRID_V = 256;      // grid cells along v
+  const int GRID_REFINE = 8;   // sub-cells per side near the boundary
+  const double CONSTANT_RATE = 0.2;   // children mutated in a constant only
+  const double CONSTANT_SIGMA = 0.1;  // step of the constant mutator
+  const bool TUNE_CONSTANTS = false;  // batched local search on best tree
+  const int TUNE_CANDIDATES = 64;     // constant vectors per round
+  const int TUNE_ROUNDS = 4;          // rounds per generation
+
+  // the bank evaluation and the pipelined engine query trees every step
+  if (ACTION_REPEAT > 1 && (PREFIX_REUSE || PIPELINED)) {
+    std::cerr << "ACTION_REPEAT > 1 cannot be combined with PREFIX_REUSE or "
+                 "PIPELINED"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
 
   // Create an initial "population" of expression trees
   vector<LinkedBinaryTree> trees;
@@ -672,13 +1914,45 @@ int main() {
 
   // Genetic Algorithm loop
   LinkedBinaryTree best_tree;
+  FitnessCache fitness_cache(NUM_PROBE, AUDIT_INTERVAL, 4 * NUM_TREE);
+  vector<pair<double, double>> bank;  // start states for prefix reuse
+  ReuseStats reuse_stats;
+  if (PREFIX_REUSE) {
+    cartCentering env;
+    for (int i = 0; i < NUM_EPISODE; i++) {
+      env.reset(rng);
+      bank.push_back({env.getCartXPos(), env.getCartXVel()});
+    }
+  }
   std::cout << "generation,fitness,steps,size,depth" << std::endl;
-  for (int g = 1; g <= MAX_GENERATIONS; g++) {
+  if (PIPELINED &&
+      !runPipelined(rng, trees, NUM_TREE, MAX_DEPTH, NUM_EPISODE,
+                    MAX_GENERATIONS, CONSTANT_RATE, CONSTANT_SIGMA,
+                    MAX_LIVE_NODES, INTERVAL_PRUNING, best_tree))
+    return EXIT_FAILURE;
+  for (int g = 1; g <= MAX_GENERATIONS && !PIPELINED; g++) {
+    // Coarse-to-fine curriculum: scores taken at a coarser action repeat are
+    // not comparable, so every tree is re-scored when the repeat changes
+    auto repeatAt = [&](int g) {
+      return max(1, ACTION_REPEAT >> ((g - 1) / REPEAT_HALVING));
+    };
+    int repeat = repeatAt(g);
+    bool rescore = g > 1 && repeat != repeatAt(g - 1);
+    if (rescore) fitness_cache.clear();
 
     // Fitness evaluation
     for (auto& t : trees) {
-      if (t.getGeneration() < g - 1) continue;  // skip if not new
-      evaluate(rng, t, NUM_EPISODE, false);
+      if (t.getGeneration() < g - 1 && !rescore) continue;  // skip if not new
+      if (INHERIT_FITNESS &&
+          fitness_cache.inherit(t, NUM_EPISODE, repeat, bank))
+        continue;
+      if (PREFIX_REUSE && reuse_stats.trees % REUSE_TIMING == 0)
+        timeBank(t, bank, reuse_stats);
+      else if (PREFIX_REUSE)
+        evaluateBank(t, bank, reuse_stats);
+      else
+        evaluate(rng, t, NUM_EPISODE, false, repeat);
+      if (INHERIT_FITNESS) fitness_cache.insert(t);
     }
 
     // sort trees using overloaded "<" op (worst->best)
@@ -701,25 +1975,74 @@ int main() {
     //Crossover
     //trees[randInt(rng, 0, NUM_TREE)].Crossover(rng,trees[randInt(rng, 0, NUM_TREE)], trees[randInt(rng, 1, NUM_TREE)]); //Calling the crossover function with two different trees to undergo switch
 
+    // Tune the constants of a copy of the best tree; the tuned copy replaces
+    // one of the children and is scored with them
+    if (TUNE_CONSTANTS) {
+      LinkedBinaryTree tuned(best_tree);
+      if (tuneConstants(rng, tuned, NUM_EPISODE, TUNE_CANDIDATES,
+                        CONSTANT_SIGMA, TUNE_ROUNDS)) {
+        tuned.setGeneration(g);
+        trees.push_back(std::move(tuned));
+      }
+    }
+
     // Selection and mutation
+    int rejected = 0;
     while (trees.size() < NUM_TREE) {
       // Selected random "parent" tree from survivors
-      LinkedBinaryTree parent = trees[randInt(rng, 0, (NUM_TREE / 2) - 1)];
+      const LinkedBinaryTree& parent = trees[randInt(rng, 0, (NUM_TREE / 2) - 1)];
       
       // Create child tree with copy constructor
       LinkedBinaryTree child(parent);
       child.setGeneration(g);
       
       // Mutation
-      // Delete a randomly selected part of the child's tree
-      child.deleteSubtreeMutator(rng);
-      // Add a random subtree to the child
-      child.addSubtreeMutator(rng, MAX_DEPTH);
-      
-      trees.push_back(child);
+      // Nudge one of the child's constants, for a fraction of children that
+      // have any; a perturbed constant changes the output almost everywhere,
+      // so these children get little from prefix reuse
+      if (randDouble(rng) >= CONSTANT_RATE ||
+          !child.constantMutator(rng, CONSTANT_SIGMA)) {
+        // Delete a randomly selected part of the child's tree
+        child.deleteSubtreeMutator(rng);
+        // Add a random subtree to the child
+        child.addSubtreeMutator(rng, MAX_DEPTH);
+      }
+      // Fold parts of the child that are constant over the state domain
+      if (INTERVAL_PRUNING) child.prune(stateDomainX(), stateDomainV());
+
+      // Drop children that would take the run over its memory ceiling, and
+      // stop the run after NUM_TREE drops in a row
+      if (LinkedBinaryTree::liveNodes() > MAX_LIVE_NODES) {
+        if (++rejected <= NUM_TREE) continue;
+        std::cerr << "Node ceiling of " << MAX_LIVE_NODES
+                  << " reached in generation " << g << std::endl;
+        return EXIT_FAILURE;
+      }
+      rejected = 0;
+
+      trees.push_back(std::move(child));
     }
+
+#ifdef LEAK_CHECK
+    // every allocated node must belong to the population, best_tree or the
+    // fitness cache
+    long owned =
+        best_tree.size() + best_tree.mutationNodes() + fitness_cache.nodes();
+    for (auto& t : trees) owned += t.size() + t.mutationNodes();
+    if (LinkedBinaryTree::liveNodes() != owned) {
+      std::cerr << "Leak in generation " << g << ": "
+                << LinkedBinaryTree::liveNodes() << " live nodes, " << owned
+                << " owned" << std::endl;
+      return EXIT_FAILURE;
+    }
+#endif
   }
 
+#ifdef LEAK_CHECK
+  std::cout << "Live nodes: " << LinkedBinaryTree::liveNodes() << std::endl;
+  return 0;  // no animation in the leak regression build
+#endif
+
 
 
   // Evaluate best tree with animation
@@ -735,4 +2058,34 @@ int main() {
   std::cout << "Size: " << best_tree.size() << std::endl;
   std::cout << "Depth: " << best_tree.depth() << std::endl;
   std::cout << "Fitness: " << best_tree.getScore() << std::endl << std::endl;
+  if (INHERIT_FITNESS && !PIPELINED) fitness_cache.printStats();
+  if (PREFIX_REUSE && !PIPELINED)
+    std::cout << "Prefix reuse: " << reuse_stats.replayed << " of "
+              << reuse_stats.steps << " steps followed a parent, "
+              << reuse_stats.skipped << " tree evaluations skipped; "
+              << reuse_stats.timed << " trees timed: "
+              << reuse_stats.reuse_seconds << " s with reuse, "
+              << reuse_stats.fresh_seconds << " s without" << std::endl;
+
+  if (EXPORT_CONTROLLER) {
+    exportController(best_tree, "BestController", "generated");
+    std::cout << "Controller written to generated/BestController.h"
+              << std::endl;
+  }
+
+  if (SWEEP) {
+    cartCentering env;
+    robustnessSweep(best_tree, SWEEP_SCALE * env.getMinVarIni(),
+                    SWEEP_SCALE * env.getMaxVarIni(), SWEEP_GRID, SWEEP_SAMPLES,
+                    200, 20, "sweep");
+  }
+
+  if (ACTION_REPEAT > 1)
+    reportRepeatFidelity(rng, best_tree, 1000, ACTION_REPEAT);
+
+  // Distill best tree and compare grid control with exact control
+  if (DISTILL) {
+    DecisionGrid grid = distill(best_tree, GRID_X, GRID_V, GRID_REFINE);
+    validateGrid(rng, best_tree, grid, 1000);
+  }
 }
\ No newline at end of file